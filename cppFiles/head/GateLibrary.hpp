@@ -5,10 +5,17 @@
 #include <map>
 #include <stdexcept>
 #include <complex>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <list>
 
 class GateLibrary {
 private:
     std::map<std::string, Gate> m_gate_map;
+    // parameterized rotations in least-recently-used order, bounded by MAX_ROTATIONS
+    std::list<std::string> m_rotation_lru;
+    std::map<std::string, std::list<std::string>::iterator> m_rotation_pos;
 
 public:
     GateLibrary() {
@@ -36,6 +43,42 @@ public:
         m_gate_map[gate.name] = gate;
     }
  
+    // a batch of at most this many gates never loses one of its rotations to eviction
+    static constexpr size_t MAX_ROTATIONS = 4096;
+
+    // parameterized rotation, registered on first use under a name like "RZ(0.78539816339744828)",
+    // the least recently used rotation is dropped once MAX_ROTATIONS are registered
+    std::string rotation(char axis, double theta) {
+        std::ostringstream oss;
+        oss << "R" << axis << "(" << std::setprecision(17) << theta << ")";
+        std::string name = oss.str();
+        auto pos = m_rotation_pos.find(name);
+        if (pos != m_rotation_pos.end()) {
+            m_rotation_lru.splice(m_rotation_lru.end(), m_rotation_lru, pos->second);
+            return name;
+        }
+
+        using namespace std::complex_literals;
+        double c = std::cos(theta / 2.0), s = std::sin(theta / 2.0);
+        MatrixXc R(2, 2);
+        switch (axis) {
+            case 'X': R << c, -1i * s, -1i * s, c; break;
+            case 'Y': R << c, -s, s, c; break;
+            case 'Z': R << std::exp(-0.5i * theta), 0, 0, std::exp(0.5i * theta); break;
+            default: throw std::runtime_error(std::string("Invalid rotation axis: ") + axis);
+        }
+
+        if (m_rotation_lru.size() >= MAX_ROTATIONS) {
+            const std::string& oldest = m_rotation_lru.front();
+            m_gate_map.erase(oldest);
+            m_rotation_pos.erase(oldest);
+            m_rotation_lru.pop_front();
+        }
+        m_gate_map[name] = Gate(name, 1, 20.0, false, R);
+        m_rotation_pos[name] = m_rotation_lru.insert(m_rotation_lru.end(), name);
+        return name;
+    }
+ 
     const Gate& get(const std::string& name) const {
         auto it = m_gate_map.find(name);
         if (it == m_gate_map.end()) {
@@ -46,4 +89,7 @@ public:
     }
 };
 
+// shared library instance, defined in SimDriver.cpp
+extern GateLibrary gate_lib;
+
 #endif
\ No newline at end of file
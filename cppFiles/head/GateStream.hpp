@@ -0,0 +1,59 @@
+#ifndef GATE_STREAM_HPP
+#define GATE_STREAM_HPP
+
+#include <vector>
+
+// gate opcodes issued by the RTL, keep in sync with svFiles/module_top.sv
+enum GateOpcode {
+    OP_NOP  = 0,
+    OP_X    = 1,
+    OP_H    = 2,
+    OP_CNOT = 3,
+    OP_SWAP = 4,
+    OP_RX   = 5,
+    OP_RY   = 6,
+    OP_RZ   = 7
+};
+
+struct IssuedGate {
+    int opcode;
+    int q0;
+    int q1;
+    double param; // rotation angle for OP_RX/RY/RZ
+};
+
+// Collects gates issued through DPI-C during eval(), SimDriver drains them as one batch.
+// Only raw opcodes are stored here so a DPI call costs a single push_back.
+class GateStream {
+private:
+    std::vector<IssuedGate> m_pending;
+    bool m_barrier = false;
+
+    GateStream() = default;
+
+public:
+    static GateStream& instance() {
+        static GateStream stream;
+        return stream;
+    }
+
+    void push(const IssuedGate& g) { m_pending.push_back(g); }
+    void barrier() { m_barrier = true; }
+
+    bool empty() const { return m_pending.empty(); }
+    bool barrier_requested() const { return m_barrier; }
+
+    // hand over everything issued so far, the buffer keeps its capacity
+    void drain(std::vector<IssuedGate>& out) {
+        out.swap(m_pending);
+        m_pending.clear();
+        m_barrier = false;
+    }
+
+    void clear() {
+        m_pending.clear();
+        m_barrier = false;
+    }
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef OBSERVABLE_PROBE_HPP
+#define OBSERVABLE_PROBE_HPP
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include "Qubits.hpp"
+
+// width of module_top's q_pop[], the Makefile passes the same value to the RTL
+#ifndef QSIM_NUM_QUBITS
+#define QSIM_NUM_QUBITS 3
+#endif
+
+// Quantum observables sampled by the RTL through DPI-C so they land in the waveform as reals.
+// SimDriver bumps the version whenever the state changes; the RTL only re-reads the values
+// when the version moved, and the batch of expectation values is evaluated once per version.
+class ObservableProbe {
+private:
+    Qubits* m_qubits = nullptr;
+    int m_version = 1;
+    int m_sampled_version = 0;
+    double m_trace = 0.0;
+    std::vector<double> m_populations; // P(qubit q = |1>)
+    bool m_warned = false;
+
+    ObservableProbe() = default;
+
+public:
+    static ObservableProbe& instance() {
+        static ObservableProbe probe;
+        return probe;
+    }
+
+    void bind(Qubits* qubits) {
+        if (qubits && qubits->num_qubits() != QSIM_NUM_QUBITS) {
+            throw std::runtime_error("ObservableProbe: simulator has " + std::to_string(qubits->num_qubits())
+                                     + " qubits but the RTL samples " + std::to_string(QSIM_NUM_QUBITS)
+                                     + ", rebuild with NUM_QUBITS=" + std::to_string(qubits->num_qubits()));
+        }
+        m_qubits = qubits;
+        invalidate();
+    }
+    void invalidate() { ++m_version; }
+    int version() const { return m_version; }
+
+    double trace();
+    double population(int q);
+
+private:
+    void refresh();
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PAULI_STRING_HPP
+#define PAULI_STRING_HPP
+
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+
+// Pauli string stored in symplectic form: P = i^num_y * X^x_mask * Z^z_mask
+// bit q of a mask acts on qubit q (same bit order as the density matrix index)
+struct PauliString {
+    uint64_t x_mask = 0;
+    uint64_t z_mask = 0;
+    int num_y = 0;
+
+    // ops[q] in {I,X,Y,Z} acts on qubit q, e.g. "ZZI" = Z0 Z1
+    static PauliString from_string(const std::string& ops) {
+        if (ops.size() > 64) throw std::runtime_error("Pauli string too long: " + ops);
+        PauliString p;
+        for (size_t q = 0; q < ops.size(); ++q) {
+            uint64_t bit = 1ULL << q;
+            switch (ops[q]) {
+                case 'I': case 'i': break;
+                case 'X': case 'x': p.x_mask |= bit; break;
+                case 'Z': case 'z': p.z_mask |= bit; break;
+                case 'Y': case 'y': p.x_mask |= bit; p.z_mask |= bit; ++p.num_y; break;
+                default: throw std::runtime_error("Invalid Pauli operator in: " + ops);
+            }
+        }
+        return p;
+    }
+
+    // single-qubit Pauli on qubit q, e.g. single('Z', 2) = Z2
+    static PauliString single(char op, int qubit) {
+        return from_string(std::string(qubit, 'I') + op);
+    }
+
+    std::string to_string(int num_qubits) const {
+        std::string s(num_qubits, 'I');
+        for (int q = 0; q < num_qubits; ++q) {
+            bool x = (x_mask >> q) & 1ULL, z = (z_mask >> q) & 1ULL;
+            if (x && z) s[q] = 'Y';
+            else if (x) s[q] = 'X';
+            else if (z) s[q] = 'Z';
+        }
+        return s;
+    }
+};
+
+#endif
@@ -3,91 +3,212 @@
 
 #include "Qubits.hpp"
 #include <vector>
+#include <map>
 #include <cmath>
 #include <iomanip>
 #include <Eigen/Dense>
 #include <Eigen/Geometry>
-#include "GateLibrary.hpp" 
+#include "GateLibrary.hpp"
+#include "QubitModule/DMKernels.hpp"
 
 using Vector3d = Eigen::Vector3d;
 
 class BlochSphereModule : public QubitModule {
+public:
+    // Rotation:     product-state model, each 1-qubit gate rotates its Bloch vector
+    // ReducedState: true per-qubit vectors from the global rho, install next to DensityMatrixModule
+    enum class Mode { Rotation, ReducedState };
+
 private:
-    std::vector<Vector3d> m_vectors;
+    Eigen::Matrix3Xd m_vectors; // column q = Bloch vector of qubit q
     const GateLibrary& m_gate_lib;
+    Mode m_mode;
+    std::map<std::string, Eigen::Matrix3d> m_rotation_cache; // gate name -> SO(3)
+    const std::complex<double>* m_rho = nullptr;
+    size_t m_dim = 0;
+    bool m_dirty = false; // ReducedState: rho changed since the last refresh
 
 public:
-    BlochSphereModule(const GateLibrary& lib) : m_gate_lib(lib) {}
+    BlochSphereModule(const GateLibrary& lib, Mode mode = Mode::Rotation) : m_gate_lib(lib), m_mode(mode) {}
+
+    bool requests_global_state() const override { return m_mode == Mode::ReducedState; }
+
+    void attach_data(std::complex<double>* raw_ptr) override {
+        m_rho = raw_ptr;
+        m_dirty = true;
+    }
 
     void on_init(int num) override {
-        m_vectors.assign(num, Vector3d(0.0, 0.0, 1.0));
+        m_dim = static_cast<size_t>(1) << num;
+        m_vectors.resize(3, num);
+        m_vectors.setZero();
+        m_vectors.row(2).setOnes();
         std::cout << "  -> [Bloch] Initialized storage for " << num << " vectors.\n";
     }
 
     void on_gate(const std::string& gate_name, int target) override {
+        if (m_mode == Mode::ReducedState) { m_dirty = true; return; }
         try {
             const Gate& gate = m_gate_lib.get(gate_name);
-            if (gate.num_qubits != 1) return; 
+            if (gate.num_qubits != 1) return;
 
-            if (target >= m_vectors.size()) return;
-            Vector3d& v = m_vectors[target];
-            apply_rotation_from_matrix(v, gate.matrix);
+            if (target < 0 || target >= m_vectors.cols()) return;
+            m_vectors.col(target) = rotation_for(gate) * m_vectors.col(target);
 
         } catch (const std::runtime_error& e) {
             std::cerr << "[Bloch Error] " << e.what() << std::endl;
         }
     }
-    
+
+    void on_multi_gate(const std::string& gate_name, const std::vector<int>& targets) override {
+        if (m_mode == Mode::ReducedState) { m_dirty = true; return; }
+        try {
+            const Gate& gate = m_gate_lib.get(gate_name);
+            for (int t : targets) if (t < 0 || t >= m_vectors.cols()) return;
+
+            if (gate.num_qubits == 1) {
+                // same gate on several qubits: one 3x3 * 3xK product
+                const Eigen::Matrix3d& R = rotation_for(gate);
+                if (static_cast<Eigen::Index>(targets.size()) == m_vectors.cols()) {
+                    m_vectors = R * m_vectors;
+                } else {
+                    Eigen::Matrix3Xd cols = m_vectors(Eigen::all, targets);
+                    m_vectors(Eigen::all, targets) = R * cols;
+                }
+                return;
+            }
+
+            if (gate.num_qubits != 2 || targets.size() != 2) return;
+            if (gate_name == "SWAP") {
+                m_vectors.col(targets[0]).swap(m_vectors.col(targets[1]));
+                return;
+            }
+            // a controlled gate only stays a product state if the control is a basis state
+            double ctrl_z = m_vectors(2, targets[0]);
+            if (gate.is_controlled && std::abs(std::abs(ctrl_z) - 1.0) < 1e-9) {
+                if (ctrl_z < 0) {
+                    m_vectors.col(targets[1]) = rotation_for(gate.name + "/V", gate.matrix.block(2, 2, 2, 2)) * m_vectors.col(targets[1]);
+                }
+                return;
+            }
+            std::cerr << "[Bloch] " << gate_name << " entangles Q" << targets[0] << " and Q" << targets[1]
+                      << ", Rotation mode can not track it (use Mode::ReducedState)." << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[Bloch Error] " << e.what() << std::endl;
+        }
+    }
+
+    // rotations are composed per qubit across the batch and applied in one pass over m_vectors,
+    // 2-qubit gates flush only the qubits they touch, as in DensityMatrixModule::on_batch
+    void on_batch(const std::vector<GateOp>& ops) override {
+        if (m_mode == Mode::ReducedState) { m_dirty = true; return; }
+        const Eigen::Index n = m_vectors.cols();
+        std::vector<Eigen::Matrix3d> pending(n, Eigen::Matrix3d::Identity());
+        std::vector<char> has_pending(n, 0);
+        auto flush = [&](int q) {
+            if (!has_pending[q]) return;
+            m_vectors.col(q) = pending[q] * m_vectors.col(q);
+            pending[q].setIdentity();
+            has_pending[q] = 0;
+        };
+
+        for (const auto& op : ops) {
+            bool in_range = true;
+            for (int t : op.targets) if (t < 0 || t >= n) in_range = false;
+            if (!in_range) continue;
+            try {
+                const Gate& gate = m_gate_lib.get(op.name);
+                if (gate.num_qubits == 1) {
+                    const Eigen::Matrix3d R = rotation_for(gate);
+                    for (int t : op.targets) {
+                        pending[t] = R * pending[t];
+                        has_pending[t] = 1;
+                    }
+                    continue;
+                }
+            } catch (const std::runtime_error& e) {
+                std::cerr << "[Bloch Error] " << e.what() << std::endl;
+                continue;
+            }
+            for (int t : op.targets) flush(t);
+            on_multi_gate(op.name, op.targets);
+        }
+        for (Eigen::Index q = 0; q < n; ++q) flush(static_cast<int>(q));
+    }
+
+    const Eigen::Matrix3Xd& vectors() {
+        if (m_dirty) refresh_from_rho();
+        return m_vectors;
+    }
+
     void on_print() override {
+        const Eigen::Matrix3Xd& vecs = vectors();
         std::cout << "--- Bloch Sphere Status ---\n";
-        for (size_t i = 0; i < m_vectors.size(); ++i) {
-            const auto& v = m_vectors[i];
-            // 修正 v.x -> v.x()
-            std::cout << "Q" << i << ": [" 
+        for (Eigen::Index i = 0; i < vecs.cols(); ++i) {
+            std::cout << "Q" << i << ": ["
                       << std::fixed << std::setprecision(4)
-                      << v.x() << ", " << v.y() << ", " << v.z() << "]\n";
+                      << vecs(0, i) << ", " << vecs(1, i) << ", " << vecs(2, i) << "]\n";
         }
     }
 
-    void reset() {
-        for (auto& v : m_vectors) {
-            v = Vector3d(0.0, 0.0, 1.0);
+    void reset() override {
+        if (m_mode == Mode::ReducedState) {
+            m_dirty = true;
+            return;
         }
+        m_vectors.setZero();
+        m_vectors.row(2).setOnes();
         std::cout << "  -> [Bloch] All vectors reset to |0> state.\n";
     }
 
 private:
-    void apply_rotation_from_matrix(Vector3d& v, const MatrixXc& U_raw) {
-        //  det(U) = 1
-        std::complex<double> det = U_raw.determinant();
-        MatrixXc U = U_raw / std::sqrt(det);
-
-        std::complex<double> trace = U.trace();
-        double cos_half_theta = trace.real() / 2.0;
-        cos_half_theta = std::max(-1.0, std::min(1.0, cos_half_theta));
-        double theta = 2.0 * std::acos(cos_half_theta);
-
-  
-        if (std::abs(theta) < 1e-9) return;
-
-   
-        //  Pauli  U = cos(t/2)I - i*sin(t/2)(nxX + nyY + nzZ)
-        double sin_half_theta = std::sin(theta / 2.0);
-        
-        // if theta close to 0 ,sin_half_theta close to 0, avoid div by zero
-        if (std::abs(sin_half_theta) < 1e-9) return;
-
-        double nx = -U(0, 1).imag() / sin_half_theta; 
-        double ny = -U(0, 1).real() / sin_half_theta;
-        double nz = (U(1, 1).imag() - U(0, 0).imag()) / (2.0 * sin_half_theta);
-        
-        Vector3d axis(nx, ny, nz);
-        if (axis.norm() > 1e-9) {
-           axis.normalize();
+    // R_ij = 1/2 Re Tr(s_i U s_j U^dag), the global phase of U drops out
+    static Eigen::Matrix3d so3_from_su2(const Eigen::Matrix2cd& U) {
+        using namespace std::complex_literals;
+        Eigen::Matrix2cd s[3];
+        s[0] << 0, 1, 1, 0;
+        s[1] << 0, -1i, 1i, 0;
+        s[2] << 1, 0, 0, -1;
+
+        Eigen::Matrix3d R;
+        for (int j = 0; j < 3; ++j) {
+            Eigen::Matrix2cd rotated = U * s[j] * U.adjoint();
+            for (int i = 0; i < 3; ++i) {
+                R(i, j) = 0.5 * (s[i] * rotated).trace().real();
+            }
         }
+        return R;
+    }
+
+    const Eigen::Matrix3d& rotation_for(const std::string& key, const Eigen::Matrix2cd& U) {
+        auto it = m_rotation_cache.find(key);
+        if (it == m_rotation_cache.end()) {
+            // parameterized rotations make the key space unbounded, start over when it gets large
+            if (m_rotation_cache.size() >= GateLibrary::MAX_ROTATIONS) m_rotation_cache.clear();
+            it = m_rotation_cache.emplace(key, so3_from_su2(U)).first;
+        }
+        return it->second;
+    }
 
-        Eigen::AngleAxisd rotation(theta, axis);
-        v = rotation * v;
+    const Eigen::Matrix3d& rotation_for(const Gate& gate) {
+        return rotation_for(gate.name, gate.matrix);
+    }
+
+    // one batched sweep of rho gives all N reduced 2x2 states
+    void refresh_from_rho() {
+        m_dirty = false;
+        if (!m_rho) return;
+        int n = static_cast<int>(m_vectors.cols());
+        std::vector<Eigen::Matrix2cd> reduced(n);
+        DMKernels::reduced_single_qubit_states(m_rho, m_dim, n, reduced.data());
+        for (int q = 0; q < n; ++q) {
+            const Eigen::Matrix2cd& r = reduced[q];
+            double tr = (r(0, 0) + r(1, 1)).real();
+            if (std::abs(tr) < 1e-12) tr = 1.0;
+            m_vectors(0, q) = 2.0 * r(1, 0).real() / tr;
+            m_vectors(1, q) = 2.0 * r(1, 0).imag() / tr;
+            m_vectors(2, q) = (r(0, 0) - r(1, 1)).real() / tr;
+        }
     }
 };
-#endif
\ No newline at end of file
+#endif
@@ -3,7 +3,9 @@
 
 #include <complex>
 #include <cstddef> // for size_t
+#include <vector>
 #include "Eigen/Dense" 
+#include "PauliString.hpp"
 
 namespace DMKernels {
     
@@ -18,6 +20,14 @@ namespace DMKernels {
 
     void apply_single_qubit_gate(std::complex<double>* rho, size_t dim, 
                                  int target, const Eigen::Matrix2cd& U);
+
+    // out[k] = Tr(rho * terms[k]), all terms evaluated in one sweep over the rows of rho
+    void expectation_pauli_batch(const std::complex<double>* rho, size_t dim,
+                                 const std::vector<PauliString>& terms, double* out);
+
+    // out[q] = Tr_{all but q}(rho) for q in [0, num_qubits), all reduced states from one sweep
+    void reduced_single_qubit_states(const std::complex<double>* rho, size_t dim,
+                                     int num_qubits, Eigen::Matrix2cd* out);
 }
 
 #endif
\ No newline at end of file
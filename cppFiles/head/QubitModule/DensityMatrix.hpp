@@ -4,6 +4,7 @@
 #include "Qubits.hpp"
 #include <complex>
 #include <vector>
+#include <map>
 #include <iostream>
 #include "QubitModule/DMKernels.hpp"
 
@@ -41,6 +42,13 @@ public:
         if (!m_rho) return;
 
         const Gate& gate = m_gate_lib.get(gate_name);
+
+        // single-qubit gate broadcast to every listed qubit
+        if (gate.num_qubits == 1) {
+            Eigen::Matrix2cd fixed_mat = gate.matrix;
+            for (int t : targets) DMKernels::apply_single_qubit_gate(m_rho, m_dim, t, fixed_mat);
+            return;
+        }
         
         if (gate.num_qubits == 2 && targets.size() == 2) {
             if(gate_name == "SWAP") {
@@ -60,6 +68,37 @@ public:
         }
     }
 
+    // runs of 1-qubit gates on the same qubit are fused into one 2x2 before touching rho,
+    // pending gates are flushed only when a 2-qubit gate needs that qubit
+    void on_batch(const std::vector<GateOp>& ops) override {
+        if (!m_rho) return;
+        std::map<int, Eigen::Matrix2cd> pending;
+        auto flush = [&](int q) {
+            auto it = pending.find(q);
+            if (it == pending.end()) return;
+            DMKernels::apply_single_qubit_gate(m_rho, m_dim, q, it->second);
+            pending.erase(it);
+        };
+
+        for (const auto& op : ops) {
+            const Gate& gate = m_gate_lib.get(op.name);
+            if (gate.num_qubits == 1) {
+                Eigen::Matrix2cd U = gate.matrix;
+                for (int t : op.targets) {
+                    auto it = pending.find(t);
+                    if (it == pending.end()) pending.emplace(t, U);
+                    else it->second = U * it->second;
+                }
+            } else {
+                for (int t : op.targets) flush(t);
+                on_multi_gate(op.name, op.targets);
+            }
+        }
+        for (auto& kv : pending) {
+            DMKernels::apply_single_qubit_gate(m_rho, m_dim, kv.first, kv.second);
+        }
+    }
+
     void on_print() override {
         // 对于 18-Qubit，打印完整矩阵是不可能的，这里只打印迹 Trace
         std::cout << "--- Density Matrix Status ---\n";
@@ -71,6 +110,13 @@ public:
         std::cout << "  -> Trace: " << trace.real() << " + " << trace.imag() << "j (Should be 1.0)\n";
     }
 
+    bool on_expectation(const std::vector<PauliString>& terms, std::vector<double>& out) override {
+        if (!m_rho) return false;
+        out.resize(terms.size());
+        DMKernels::expectation_pauli_batch(m_rho, m_dim, terms, out.data());
+        return true;
+    }
+
     void try_print_full_matrix() override {
         if (m_num_qubits > 6) {
             std::cout << "--- We do not suggest printing full matrix for >6 qubits ---\n";
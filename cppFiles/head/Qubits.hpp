@@ -7,6 +7,13 @@
 #include <iostream>
 #include <complex> 
 #include <omp.h> 
+#include "PauliString.hpp"
+
+// one gate of a batch, targets.size() == 1 for single-qubit gates
+struct GateOp {
+    std::string name;
+    std::vector<int> targets;
+};
 
 class QubitModule {
 public:
@@ -16,7 +23,16 @@ public:
     virtual void attach_data(std::complex<double>* raw_state_ptr) {} 
     virtual void on_gate(const std::string& gate, int target_q) {}
     virtual void on_multi_gate(const std::string& gate, const std::vector<int>& target_qs) {}
+    // gates issued together (e.g. in one RTL cycle), override to fuse or reorder them
+    virtual void on_batch(const std::vector<GateOp>& ops) {
+        for (const auto& op : ops) {
+            if (op.targets.size() == 1) on_gate(op.name, op.targets[0]);
+            else on_multi_gate(op.name, op.targets);
+        }
+    }
     virtual void on_print() {}
+    // fill out[k] = <terms[k]>, return false if this module can not evaluate observables
+    virtual bool on_expectation(const std::vector<PauliString>& terms, std::vector<double>& out) { return false; }
     virtual void try_print_full_matrix() {}
     virtual void reset() {}
 };
@@ -40,11 +56,14 @@ public:
     
     Qubits(int num);
     ~Qubits();
+    int num_qubits() const { return m_num_qubits; }
     void bind_sim_time(const uint64_t* time_ptr);
     void install_module(std::shared_ptr<QubitModule> mod);
     void apply_gate(std::string name, int target); 
     void apply_multi_gate(std::string name, const std::vector<int>& targets);
+    void apply_batch(const std::vector<GateOp>& ops);
     void print_status();
+    std::vector<double> expectation_values(const std::vector<PauliString>& terms);
     void reset();
     void print_full_matrix();
 };
@@ -5,6 +5,8 @@
 #include "Qubits.hpp"
 #include "QubitModule/BlochSphere.hpp" 
 #include "QubitModule/DensityMatrix.hpp"
+#include "GateStream.hpp"
+#include "ObservableProbe.hpp"
 // 前向声明 Verilator 的模型类，避免在头文件中包含巨大 generated 头文件
 class Vmodule_top; 
 
@@ -14,15 +16,25 @@ private:
     Qubits* qubits;   
     int m_last_rst_n;
     uint64_t m_sim_clock = 0;
+    int m_last_seq_done = 0;
+    // gates issued by the RTL are held for this many time steps (or until a barrier)
+    uint64_t m_batch_window;
+    uint64_t m_batch_start = 0;
+    std::vector<IssuedGate> m_issued;
+    std::vector<GateOp> m_batch;
 public:
     
-    SimDriver(Vmodule_top* top_ptr , int num_qubits=3 , short select_module=1);
+    SimDriver(Vmodule_top* top_ptr , int num_qubits=QSIM_NUM_QUBITS , short select_module=1, uint64_t batch_window=1);
     ~SimDriver();
     void step(uint64_t time);
 
 private:
     void init_qubits(int num_qubits);
     void rst_n();
+    void print_observables();
+    void flush_gate_stream(uint64_t time);
+    void apply_pending_batch();
+    GateOp decode(const IssuedGate& g);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef SIM_SERVER_HPP
+#define SIM_SERVER_HPP
+
+#include <string>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "Qubits.hpp"
+
+// Long-lived simulation server: the global state and the GateLibrary are allocated once,
+// circuit jobs arrive over a Unix-domain socket and run back-to-back with a reset in between.
+//
+// Job (text, one statement per line, terminated by END or by closing the write side):
+//   H 0
+//   CNOT 0 1
+//   RZ 1 0.785398
+//   EXPECT ZZI XXI
+//   END
+// Reply: "OK gates=<n> ms=<t>" followed by "<pauli> <value>" per EXPECT term, or "ERR <msg>".
+// A job consisting of SHUTDOWN stops the server. Jobs that are too large or do not arrive
+// within JOB_DEADLINE_S are answered with ERR without blocking other clients.
+class SimServer {
+private:
+    struct Job {
+        int fd;
+        std::string text;
+    };
+
+    std::string m_socket_path;
+    std::unique_ptr<Qubits> m_qubits;
+    int m_listen_fd = -1;
+    int m_wake_pipe[2] = {-1, -1}; // stop() -> accept_loop()
+    std::thread m_acceptor;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;
+    std::atomic<bool> m_running{false};
+
+public:
+    static constexpr int JOB_DEADLINE_S = 5;               // whole job must arrive within this after accept
+    static constexpr size_t MAX_JOB_BYTES = 16u << 20;      // larger jobs are rejected with ERR
+
+    SimServer(const std::string& socket_path, int num_qubits=3);
+    ~SimServer();
+    void run(); // blocks until a SHUTDOWN job arrives
+
+private:
+    void accept_loop();
+    std::string run_job(const std::string& text);
+    void stop();
+    void close_fds();
+};
+
+#endif
@@ -1,5 +1,7 @@
 #include "QubitModule/DMKernels.hpp"
 #include <omp.h>
+#include <map>
+#include <algorithm>
 
 namespace {
 
@@ -214,6 +216,130 @@ namespace DMKernels {
         }
     }
 
+    // Math: Tr(rho * P) = i^num_y * sum_c (-1)^popcount(c & z_mask) * rho[c, c ^ x_mask]
+    // Terms with the same x_mask read the same elements, so they are grouped:
+    // every row block gathers rho[c, c ^ x_mask] once per group, then each term of the
+    // group only needs a sign-weighted sum over that buffer (simd reduction).
+    void expectation_pauli_batch(const std::complex<double>* rho, size_t dim,
+                                 const std::vector<PauliString>& terms, double* out) {
+        const size_t n_terms = terms.size();
+        if (n_terms == 0) return;
+
+        // group terms by flip pattern
+        std::map<uint64_t, size_t> group_of_x;
+        std::vector<uint64_t> group_x;
+        std::vector<std::vector<size_t>> group_terms;
+        for (size_t k = 0; k < n_terms; ++k) {
+            auto it = group_of_x.find(terms[k].x_mask);
+            if (it == group_of_x.end()) {
+                it = group_of_x.emplace(terms[k].x_mask, group_x.size()).first;
+                group_x.push_back(terms[k].x_mask);
+                group_terms.emplace_back();
+            }
+            group_terms[it->second].push_back(k);
+        }
+
+        constexpr size_t BLOCK = 256; // rows per block (power of two), gather buffers stay in L1
+        constexpr size_t LANES = 8;   // independent partial sums, lets the reduction vectorize without -ffast-math
+
+        // sign(c) = parity(c & z) = parity(base & z) * parity(i & z) for c = base + i,
+        // base is BLOCK aligned, so the i-part is a fixed +-1 table per term
+        std::vector<double> sign_table(n_terms * BLOCK);
+        for (size_t k = 0; k < n_terms; ++k) {
+            for (size_t i = 0; i < BLOCK; ++i) {
+                sign_table[k * BLOCK + i] = (__builtin_popcountll(i & terms[k].z_mask) & 1) ? -1.0 : 1.0;
+            }
+        }
+        std::vector<double> sum_re(n_terms, 0.0), sum_im(n_terms, 0.0);
+
+        #pragma omp parallel
+        {
+            std::vector<double> local_re(n_terms, 0.0), local_im(n_terms, 0.0);
+            alignas(64) double buf_re[BLOCK];
+            alignas(64) double buf_im[BLOCK];
+
+            #pragma omp for schedule(static)
+            for (size_t base = 0; base < dim; base += BLOCK) {
+                const size_t len = std::min(BLOCK, dim - base);
+                const size_t len_padded = (len + LANES - 1) / LANES * LANES;
+
+                for (size_t g = 0; g < group_x.size(); ++g) {
+                    const uint64_t x = group_x[g];
+                    // 1. gather rho[c, c^x] for this row block, zero the padding lanes
+                    for (size_t i = 0; i < len; ++i) {
+                        size_t c = base + i;
+                        const std::complex<double> v = rho[c * dim + (c ^ x)];
+                        buf_re[i] = v.real();
+                        buf_im[i] = v.imag();
+                    }
+                    for (size_t i = len; i < len_padded; ++i) buf_re[i] = buf_im[i] = 0.0;
+
+                    // 2. every term of the group reuses the gathered buffer: plain multiply-add
+                    for (size_t k : group_terms[g]) {
+                        const double* sign = sign_table.data() + k * BLOCK;
+                        double acc_re[LANES] = {0.0}, acc_im[LANES] = {0.0};
+                        for (size_t i = 0; i < len_padded; i += LANES) {
+                            for (size_t j = 0; j < LANES; ++j) {
+                                acc_re[j] += sign[i + j] * buf_re[i + j];
+                                acc_im[j] += sign[i + j] * buf_im[i + j];
+                            }
+                        }
+                        double sum_block_re = 0.0, sum_block_im = 0.0;
+                        for (size_t j = 0; j < LANES; ++j) {
+                            sum_block_re += acc_re[j];
+                            sum_block_im += acc_im[j];
+                        }
+                        const double block_sign = (__builtin_popcountll(base & terms[k].z_mask) & 1) ? -1.0 : 1.0;
+                        local_re[k] += block_sign * sum_block_re;
+                        local_im[k] += block_sign * sum_block_im;
+                    }
+                }
+            }
+
+            #pragma omp critical
+            {
+                for (size_t k = 0; k < n_terms; ++k) {
+                    sum_re[k] += local_re[k];
+                    sum_im[k] += local_im[k];
+                }
+            }
+        }
+
+        // apply the i^num_y phase and keep the real part
+        for (size_t k = 0; k < n_terms; ++k) {
+            switch (terms[k].num_y & 3) {
+                case 0: out[k] =  sum_re[k]; break;
+                case 1: out[k] = -sum_im[k]; break;
+                case 2: out[k] = -sum_re[k]; break;
+                default: out[k] = sum_im[k]; break;
+            }
+        }
+    }
+
+    // rho_q = (Tr(rho) I + <X_q> X + <Y_q> Y + <Z_q> Z) / 2
+    // The identity and every Z_q share the diagonal, X_q/Y_q share rho[c, c ^ (1<<q)],
+    // so the whole set is N+1 groups of one batched sweep instead of N partial traces.
+    void reduced_single_qubit_states(const std::complex<double>* rho, size_t dim,
+                                     int num_qubits, Eigen::Matrix2cd* out) {
+        std::vector<PauliString> terms;
+        terms.reserve(3 * num_qubits + 1);
+        terms.push_back(PauliString()); // identity -> trace
+        for (int q = 0; q < num_qubits; ++q) {
+            terms.push_back(PauliString::single('X', q));
+            terms.push_back(PauliString::single('Y', q));
+            terms.push_back(PauliString::single('Z', q));
+        }
+        std::vector<double> ev(terms.size());
+        expectation_pauli_batch(rho, dim, terms, ev.data());
+
+        const double tr = ev[0];
+        for (int q = 0; q < num_qubits; ++q) {
+            double x = ev[1 + 3 * q], y = ev[2 + 3 * q], z = ev[3 + 3 * q];
+            out[q] << std::complex<double>((tr + z) / 2, 0), std::complex<double>(x / 2, -y / 2),
+                      std::complex<double>(x / 2,  y / 2), std::complex<double>((tr - z) / 2, 0);
+        }
+    }
+
 /*
 ToDo:
 还可以压榨的性能点：
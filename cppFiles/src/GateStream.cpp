@@ -0,0 +1,14 @@
+#include "GateStream.hpp"
+#include "Vmodule_top__Dpi.h"
+
+// DPI-C entry points imported by svFiles/module_top.sv
+
+void qsim_issue_gate(int opcode, int q0, int q1, double param) {
+    if (opcode == OP_NOP) return;
+    GateStream::instance().push({opcode, q0, q1, param});
+}
+
+// end of a batch window, flush on the next SimDriver::step even if the window is still open
+void qsim_barrier() {
+    GateStream::instance().barrier();
+}
@@ -0,0 +1,50 @@
+#include "ObservableProbe.hpp"
+#include "Vmodule_top__Dpi.h"
+#include <stdexcept>
+
+// trace and every <Z_q> in one batched sweep, P1_q = (Tr(rho) - <Z_q>) / 2
+void ObservableProbe::refresh() {
+    if (m_sampled_version == m_version) return;
+    m_sampled_version = m_version;
+    if (!m_qubits) return;
+
+    int n = m_qubits->num_qubits();
+    std::vector<PauliString> terms;
+    terms.push_back(PauliString()); // identity -> trace
+    for (int q = 0; q < n; ++q) terms.push_back(PauliString::single('Z', q));
+
+    m_populations.assign(n, 0.0);
+    try {
+        std::vector<double> ev = m_qubits->expectation_values(terms);
+        m_trace = ev[0];
+        for (int q = 0; q < n; ++q) m_populations[q] = (ev[0] - ev[1 + q]) / 2.0;
+    } catch (const std::runtime_error& e) {
+        if (!m_warned) std::cerr << "[ObservableProbe] " << e.what() << std::endl;
+        m_warned = true;
+    }
+}
+
+double ObservableProbe::trace() {
+    refresh();
+    return m_trace;
+}
+
+double ObservableProbe::population(int q) {
+    refresh();
+    if (q < 0 || q >= static_cast<int>(m_populations.size())) return 0.0;
+    return m_populations[q];
+}
+
+// DPI-C entry points imported by svFiles/module_top.sv
+
+int qsim_obs_version() {
+    return ObservableProbe::instance().version();
+}
+
+double qsim_trace() {
+    return ObservableProbe::instance().trace();
+}
+
+double qsim_population(int q) {
+    return ObservableProbe::instance().population(q);
+}
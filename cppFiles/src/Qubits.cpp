@@ -1,11 +1,14 @@
 #include "Qubits.hpp"
 #include <complex> 
 #include <omp.h> 
+#include <stdexcept>
+#include <cstdlib>
+#include <new>
 Qubits::Qubits(int num) : m_num_qubits(num), m_dim(0), m_global_state(nullptr) {
 }
 
 Qubits::~Qubits() {
-    delete[] m_global_state;
+    std::free(m_global_state);
 }
 void Qubits::bind_sim_time(const uint64_t* time_ptr) {
         m_external_time_ptr = time_ptr;
@@ -23,7 +26,12 @@ void Qubits:: allocate_global_state() {
                 << (total_elements * sizeof(std::complex<double>) / (1024.0*1024.0*1024.0)) 
                 << " GB..." << std::endl;
 
-    m_global_state = new std::complex<double>[total_elements];
+    // raw allocation: new[] would value-initialize every element on this thread first,
+    // which touches all pages from one NUMA node and doubles the startup cost
+    size_t bytes = total_elements * sizeof(std::complex<double>);
+    bytes = (bytes + 63) / 64 * 64;
+    m_global_state = static_cast<std::complex<double>*>(std::aligned_alloc(64, bytes));
+    if (!m_global_state) throw std::bad_alloc();
 
     // NUMA First-Touch initialization
     #pragma omp parallel for schedule(static)
@@ -52,12 +60,34 @@ void Qubits::apply_gate(std::string name, int target) {
 void Qubits::apply_multi_gate(std::string name, const std::vector<int>& targets) {
     for (auto& mod : m_modules) mod->on_multi_gate(name, targets);
 }
+void Qubits::apply_batch(const std::vector<GateOp>& ops) {
+    if (ops.empty()) return;
+    std::cout << "[System] Applying batch of " << ops.size() << " gates" << std::endl;
+    for (auto& mod : m_modules) mod->on_batch(ops);
+}
 void Qubits::print_status() {
     for (auto& mod : m_modules) {
         mod->on_print();
     }
 }
 
+// evaluated by the first module that can, e.g. DensityMatrixModule in one sweep of rho
+std::vector<double> Qubits::expectation_values(const std::vector<PauliString>& terms) {
+    // a mask bit at or above N would index outside rho
+    for (const auto& term : terms) {
+        uint64_t used = term.x_mask | term.z_mask;
+        if (m_num_qubits < 64 && (used >> m_num_qubits) != 0) {
+            throw std::runtime_error("Pauli string " + term.to_string(64 - __builtin_clzll(used))
+                                     + " acts on qubits beyond the " + std::to_string(m_num_qubits) + "-qubit register");
+        }
+    }
+    std::vector<double> out(terms.size(), 0.0);
+    for (auto& mod : m_modules) {
+        if (mod->on_expectation(terms, out)) return out;
+    }
+    throw std::runtime_error("No installed module can evaluate expectation values");
+}
+
 void Qubits::reset() {
     std::cout << "[System] Resetting all modules..." << std::endl;
     for (auto& mod : m_modules) {
@@ -3,10 +3,12 @@
 #include "GateLibrary.hpp"
 GateLibrary gate_lib;
 
-SimDriver::SimDriver(Vmodule_top* top_ptr, int num_qubits, short select_module) : dut(top_ptr) {
+SimDriver::SimDriver(Vmodule_top* top_ptr, int num_qubits, short select_module, uint64_t batch_window)
+    : dut(top_ptr), m_batch_window(batch_window) {
     
     init_qubits(num_qubits);
     qubits->bind_sim_time(&m_sim_clock);
+    ObservableProbe::instance().bind(qubits);
     if(select_module == 1) {
         auto density_module = std::make_shared<DensityMatrixModule>(gate_lib);
         qubits->install_module(density_module);
@@ -18,7 +20,8 @@ SimDriver::SimDriver(Vmodule_top* top_ptr, int num_qubits, short select_module)
     else if(select_module == 3) {
         auto density_module = std::make_shared<DensityMatrixModule>(gate_lib);
         qubits->install_module(density_module);
-        auto bloch_module = std::make_shared<BlochSphereModule>(gate_lib);
+        // next to the density matrix, read true reduced states instead of tracking rotations
+        auto bloch_module = std::make_shared<BlochSphereModule>(gate_lib, BlochSphereModule::Mode::ReducedState);
         qubits->install_module(bloch_module);
     }
     else{
@@ -29,23 +32,110 @@ SimDriver::SimDriver(Vmodule_top* top_ptr, int num_qubits, short select_module)
 }
 
 SimDriver::~SimDriver() {
+    ObservableProbe::instance().bind(nullptr);
     delete qubits;
 }
 
 void SimDriver::step(uint64_t time) {
     rst_n();
+    flush_gate_stream(time);
     if(dut->trigger) {
         m_sim_clock = time;
-        std::cout << "[SimDriver] Time " << time << ": Trigger received. Performing operations..." << std::endl;
-       // Example: Apply a Hadamard gate to qubit 0 on trigger
-        qubits->apply_gate("H", 0);
-        qubits->print_full_matrix();
-        qubits->apply_multi_gate("CNOT", {0,1});
-        qubits->print_full_matrix();
-        qubits->apply_multi_gate("SWAP", {0,1});
+        std::cout << "[SimDriver] Time " << time << ": Trigger received. Gate program starts." << std::endl;
+    }
+    // sequencer finished its program, report the state once
+    if(dut->seq_done && !m_last_seq_done) {
         qubits->print_status();
         qubits->print_full_matrix();
-   }
+        print_observables();
+    }
+    m_last_seq_done = dut->seq_done;
+}
+
+// gates issued by the RTL in the last eval()s are handed to Qubits as one batch
+void SimDriver::flush_gate_stream(uint64_t time) {
+    GateStream& stream = GateStream::instance();
+    if (stream.empty()) {
+        m_batch_start = time;
+        return;
+    }
+    if (!stream.barrier_requested() && time - m_batch_start < m_batch_window) return;
+
+    m_sim_clock = time;
+    stream.drain(m_issued);
+    m_batch.clear();
+    for (const auto& g : m_issued) {
+        // a bad gate from the RTL is reported and skipped, the rest of the window still runs
+        try {
+            m_batch.push_back(decode(g));
+        } catch (const std::runtime_error& e) {
+            std::cerr << "[SimDriver] Time " << time << ": dropped gate: " << e.what() << std::endl;
+            continue;
+        }
+        // keep every rotation of the pending batch registered in the bounded GateLibrary
+        if (m_batch.size() >= GateLibrary::MAX_ROTATIONS) apply_pending_batch();
+    }
+    apply_pending_batch();
+    ObservableProbe::instance().invalidate();
+    m_batch_start = time;
+}
+
+void SimDriver::apply_pending_batch() {
+    try {
+        qubits->apply_batch(m_batch);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "[SimDriver] " << e.what() << std::endl;
+    }
+    m_batch.clear();
+}
+
+// operands come straight from RTL, anything outside the register would write past rho
+GateOp SimDriver::decode(const IssuedGate& g) {
+    GateOp op;
+    switch (g.opcode) {
+        case OP_X:    op = {"X", {g.q0}}; break;
+        case OP_H:    op = {"H", {g.q0}}; break;
+        case OP_CNOT: op = {"CNOT", {g.q0, g.q1}}; break;
+        case OP_SWAP: op = {"SWAP", {g.q0, g.q1}}; break;
+        case OP_RX:   op = {"", {g.q0}}; break;
+        case OP_RY:   op = {"", {g.q0}}; break;
+        case OP_RZ:   op = {"", {g.q0}}; break;
+        default: throw std::runtime_error("Unknown gate opcode: " + std::to_string(g.opcode));
+    }
+    for (int q : op.targets) {
+        if (q < 0 || q >= qubits->num_qubits()) {
+            throw std::runtime_error("Qubit out of range for opcode " + std::to_string(g.opcode) + ": Q" + std::to_string(q));
+        }
+    }
+    if (op.targets.size() == 2 && op.targets[0] == op.targets[1]) {
+        throw std::runtime_error("Duplicate qubit operand for opcode " + std::to_string(g.opcode) + ": Q" + std::to_string(g.q0));
+    }
+    // register the rotation only once the operands are known to be valid
+    if (g.opcode == OP_RX) op.name = gate_lib.rotation('X', g.param);
+    if (g.opcode == OP_RY) op.name = gate_lib.rotation('Y', g.param);
+    if (g.opcode == OP_RZ) op.name = gate_lib.rotation('Z', g.param);
+    return op;
+}
+
+// per-qubit <Z> and nearest-neighbour <ZZ>, evaluated as one batch
+void SimDriver::print_observables() {
+    int n = qubits->num_qubits();
+    std::vector<PauliString> terms;
+    for (int q = 0; q < n; ++q) terms.push_back(PauliString::single('Z', q));
+    for (int q = 0; q + 1 < n; ++q) {
+        std::string ops(n, 'I');
+        ops[q] = ops[q + 1] = 'Z';
+        terms.push_back(PauliString::from_string(ops));
+    }
+    try {
+        std::vector<double> values = qubits->expectation_values(terms);
+        std::cout << "--- Observables ---\n";
+        for (size_t k = 0; k < terms.size(); ++k) {
+            std::cout << "  <" << terms[k].to_string(n) << "> = " << values[k] << "\n";
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "[SimDriver] " << e.what() << std::endl;
+    }
 }
 
 void SimDriver::init_qubits(int num_qubits) {
@@ -58,7 +148,9 @@ void SimDriver::rst_n() {
     int current_rst_n   = dut->rst_n;
     if (m_last_rst_n == 1 && current_rst_n == 0) {
         std::cout << "[SimDriver] Detected Reset Asserted. Resetting Qubits..." << std::endl;
+        GateStream::instance().clear();
         qubits->reset();
+        ObservableProbe::instance().invalidate();
     }
     m_last_rst_n       = current_rst_n;
 }
\ No newline at end of file
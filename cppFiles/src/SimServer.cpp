@@ -0,0 +1,298 @@
+#include "SimServer.hpp"
+#include "GateLibrary.hpp"
+#include "QubitModule/DensityMatrix.hpp"
+#include <sstream>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+    // a job is complete at a line "END"; only the newly appended bytes (plus overlap) are scanned
+    bool job_complete(const std::string& text, size_t scanned_from) {
+        if (text.compare(0, 3, "END") == 0) return true;
+        size_t from = scanned_from >= 3 ? scanned_from - 3 : 0;
+        return text.find("\nEND", from) != std::string::npos;
+    }
+
+    // MSG_NOSIGNAL: a client that went away must not SIGPIPE the server
+    void write_all(int fd, const std::string& s) {
+        size_t off = 0;
+        while (off < s.size()) {
+            ssize_t n = ::send(fd, s.data() + off, s.size() - off, MSG_NOSIGNAL);
+            if (n <= 0) return;
+            off += n;
+        }
+    }
+
+    void set_nonblocking(int fd, bool on) {
+        int flags = ::fcntl(fd, F_GETFL, 0);
+        ::fcntl(fd, F_SETFL, on ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+    }
+
+    void reject(int fd, const std::string& msg) {
+        write_all(fd, "ERR " + msg + "\n");
+        ::close(fd);
+    }
+}
+
+SimServer::SimServer(const std::string& socket_path, int num_qubits) : m_socket_path(socket_path) {
+    // validate everything before the state allocation: rho needs 16 * 4^N bytes,
+    // N <= 29 keeps that inside size_t, the physical memory check is the real bound
+    if (num_qubits < 1 || num_qubits > 29) {
+        throw std::runtime_error("Qubit count must be in [1, 29], got " + std::to_string(num_qubits));
+    }
+    const size_t state_bytes = sizeof(std::complex<double>) << (2 * num_qubits);
+    const size_t phys_bytes = static_cast<size_t>(::sysconf(_SC_PHYS_PAGES)) * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    if (state_bytes > phys_bytes) {
+        throw std::runtime_error(std::to_string(num_qubits) + " qubits need " + std::to_string(state_bytes >> 20)
+                                 + " MiB of state, the machine has " + std::to_string(phys_bytes >> 20) + " MiB");
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) throw std::runtime_error("Socket path too long: " + socket_path);
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (::pipe(m_wake_pipe) < 0) throw std::runtime_error("pipe() failed");
+    m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_listen_fd < 0) {
+        close_fds();
+        throw std::runtime_error("socket() failed");
+    }
+    ::unlink(socket_path.c_str());
+
+    if (::bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        ::listen(m_listen_fd, 64) < 0) {
+        close_fds();
+        throw std::runtime_error("Can not listen on " + socket_path);
+    }
+    set_nonblocking(m_listen_fd, true);
+
+    try {
+        m_qubits = std::make_unique<Qubits>(num_qubits);
+        // allocation and first-touch happen here, once for the lifetime of the server
+        m_qubits->install_module(std::make_shared<DensityMatrixModule>(gate_lib));
+    } catch (...) {
+        close_fds();
+        ::unlink(socket_path.c_str());
+        throw;
+    }
+    std::cout << "[SimServer] Listening on " << socket_path << " with " << num_qubits << " qubits." << std::endl;
+}
+
+SimServer::~SimServer() {
+    stop();
+    ::unlink(m_socket_path.c_str());
+}
+
+void SimServer::run() {
+    m_running = true;
+    m_acceptor = std::thread(&SimServer::accept_loop, this);
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv.wait(lock, [this] { return !m_queue.empty() || !m_running; });
+            if (m_queue.empty()) break;
+            job = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        if (job.text.compare(0, 8, "SHUTDOWN") == 0) {
+            write_all(job.fd, "OK shutdown\n");
+            ::close(job.fd);
+            break;
+        }
+        write_all(job.fd, run_job(job.text));
+        ::close(job.fd);
+    }
+    stop();
+}
+
+// Reads all connections with poll(), so a slow client never delays the others.
+// Every job has to arrive completely within JOB_DEADLINE_S of its accept() and
+// stay below MAX_JOB_BYTES, otherwise the client gets ERR and is dropped.
+// Execution stays on the run() thread so gates never overlap.
+void SimServer::accept_loop() {
+    using clock = std::chrono::steady_clock;
+    struct Connection {
+        int fd;
+        std::string text;
+        clock::time_point deadline;
+    };
+    std::vector<Connection> conns;
+    std::vector<pollfd> pfds;
+
+    while (m_running) {
+        pfds.clear();
+        pfds.push_back({m_wake_pipe[0], POLLIN, 0});
+        pfds.push_back({m_listen_fd, POLLIN, 0});
+        int timeout_ms = -1;
+        const auto now = clock::now();
+        for (const auto& c : conns) {
+            pfds.push_back({c.fd, POLLIN, 0});
+            long left = std::chrono::duration_cast<std::chrono::milliseconds>(c.deadline - now).count();
+            left = std::max(left, 0L) + 1;
+            if (timeout_ms < 0 || left < timeout_ms) timeout_ms = static_cast<int>(left);
+        }
+
+        if (::poll(pfds.data(), pfds.size(), timeout_ms) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (pfds[0].revents) break; // stop() woke us up
+
+        // pfds[2 + i] belongs to conns[i], new connections are appended after this pass
+        std::vector<Connection> still_open;
+        for (size_t i = 0; i < conns.size(); ++i) {
+            Connection& c = conns[i];
+            bool eof = false, failed = false;
+            if (pfds[2 + i].revents) {
+                char buf[4096];
+                size_t scanned_from = c.text.size();
+                while (true) {
+                    ssize_t n = ::read(c.fd, buf, sizeof(buf));
+                    if (n > 0) { c.text.append(buf, n); continue; }
+                    if (n == 0) eof = true;
+                    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) failed = true;
+                    break;
+                }
+                if (failed) { ::close(c.fd); continue; }
+                if (c.text.size() > MAX_JOB_BYTES) {
+                    reject(c.fd, "job larger than " + std::to_string(MAX_JOB_BYTES) + " bytes");
+                    continue;
+                }
+                if (eof || job_complete(c.text, scanned_from)) {
+                    set_nonblocking(c.fd, false); // the reply is written with blocking sends
+                    {
+                        std::lock_guard<std::mutex> lock(m_mutex);
+                        m_queue.push_back({c.fd, std::move(c.text)});
+                    }
+                    m_cv.notify_one();
+                    continue;
+                }
+            }
+            if (clock::now() >= c.deadline) {
+                reject(c.fd, "job not received within " + std::to_string(JOB_DEADLINE_S) + " s");
+                continue;
+            }
+            still_open.push_back(std::move(c));
+        }
+        conns.swap(still_open);
+
+        if (pfds[1].revents & POLLIN) {
+            int fd;
+            while ((fd = ::accept(m_listen_fd, nullptr, nullptr)) >= 0) {
+                set_nonblocking(fd, true);
+                conns.push_back({fd, std::string(), clock::now() + std::chrono::seconds(JOB_DEADLINE_S)});
+            }
+        }
+    }
+
+    for (auto& c : conns) reject(c.fd, "server stopped");
+}
+
+void SimServer::close_fds() {
+    for (int* fd : {&m_listen_fd, &m_wake_pipe[0], &m_wake_pipe[1]}) {
+        if (*fd >= 0) ::close(*fd);
+        *fd = -1;
+    }
+}
+
+void SimServer::stop() {
+    m_running = false;
+    m_cv.notify_all();
+    if (m_wake_pipe[1] >= 0) {
+        char wake = 0;
+        if (::write(m_wake_pipe[1], &wake, 1) < 0) { /* acceptor exits on m_running anyway */ }
+    }
+    if (m_acceptor.joinable()) m_acceptor.join();
+    close_fds();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& job : m_queue) reject(job.fd, "server stopped");
+    m_queue.clear();
+}
+
+std::string SimServer::run_job(const std::string& text) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::ostringstream result;
+    std::vector<GateOp> batch;
+    size_t gate_count = 0;
+
+    try {
+        // state is already allocated, a reset only rewrites it in place
+        m_qubits->reset();
+
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::istringstream ls(line);
+            std::string op;
+            if (!(ls >> op) || op[0] == '#') continue;
+            if (op == "END") break;
+
+            if (op == "EXPECT") {
+                m_qubits->apply_batch(batch);
+                batch.clear();
+                std::vector<std::string> names;
+                std::vector<PauliString> terms;
+                std::string term;
+                while (ls >> term) {
+                    names.push_back(term);
+                    terms.push_back(PauliString::from_string(term));
+                }
+                std::vector<double> values = m_qubits->expectation_values(terms);
+                for (size_t k = 0; k < terms.size(); ++k) {
+                    result << names[k] << " " << values[k] << "\n";
+                }
+                continue;
+            }
+
+            GateOp gate_op;
+            if (op == "RX" || op == "RY" || op == "RZ") {
+                int q;
+                double theta;
+                if (!(ls >> q >> theta)) throw std::runtime_error("Bad rotation: " + line);
+                gate_op = {gate_lib.rotation(op[1], theta), {q}};
+            } else {
+                const Gate& gate = gate_lib.get(op);
+                gate_op.name = op;
+                for (int i = 0; i < gate.num_qubits; ++i) {
+                    int q;
+                    if (!(ls >> q)) throw std::runtime_error("Missing qubit operand: " + line);
+                    gate_op.targets.push_back(q);
+                }
+            }
+            for (int q : gate_op.targets) {
+                if (q < 0 || q >= m_qubits->num_qubits()) throw std::runtime_error("Qubit out of range: " + line);
+            }
+            if (gate_op.targets.size() == 2 && gate_op.targets[0] == gate_op.targets[1]) {
+                throw std::runtime_error("Duplicate qubit operand: " + line);
+            }
+            batch.push_back(std::move(gate_op));
+            ++gate_count;
+            // keep every rotation of the pending batch registered in the bounded GateLibrary
+            if (batch.size() >= GateLibrary::MAX_ROTATIONS) {
+                m_qubits->apply_batch(batch);
+                batch.clear();
+            }
+        }
+        m_qubits->apply_batch(batch);
+    } catch (const std::runtime_error& e) {
+        return std::string("ERR ") + e.what() + "\n";
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    std::ostringstream reply;
+    reply << "OK gates=" << gate_count << " ms=" << ms << "\n" << result.str();
+    return reply.str();
+}
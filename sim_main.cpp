@@ -1,18 +1,65 @@
 #include "Vmodule_top.h"
 #include "verilated.h"
+#ifdef QSIM_TRACE_FST
+#include "verilated_fst_c.h"
+using TraceFile = VerilatedFstC;
+static const char* WAVE_FILE = "wave.fst";
+#else
 #include "verilated_vcd_c.h" 
+using TraceFile = VerilatedVcdC;
+static const char* WAVE_FILE = "wave.vcd";
+#endif
 #include "SimDriver.hpp" 
+#include "SimServer.hpp"
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+// +name=<int>, or fallback when the plusarg is absent
+static long plusarg_int(const char* name, long fallback) {
+    std::string key = std::string(name) + "=";
+    const char* arg = Verilated::commandArgsPlusMatch(key.c_str());
+    if (!arg[0]) return fallback;
+    return std::atol(arg + 1 + key.size());
+}
+
 int main(int argc, char** argv) {
     Verilated::commandArgs(argc, argv);
+
+    // server mode: ./obj_dir/Vmodule_top +server=/tmp/qsim.sock [+qubits=N]
+    const char* server_arg = Verilated::commandArgsPlusMatch("server=");
+    if (server_arg[0]) {
+        std::string socket_path = std::string(server_arg).substr(std::strlen("+server="));
+        // range and memory checks are done by SimServer
+        long num_qubits = plusarg_int("qubits", QSIM_NUM_QUBITS);
+        try {
+            // clamp first so a huge value can not wrap into range through the int cast
+            SimServer server(socket_path, static_cast<int>(std::clamp(num_qubits, -1L, 1024L)));
+            server.run();
+        } catch (const std::exception& e) {
+            std::cerr << "[SimServer] " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
     Vmodule_top* top = new Vmodule_top;
 
     // --- open wave ---
-    Verilated::traceEverOn(true);
-    VerilatedVcdC* tfp = new VerilatedVcdC;
+    // +notrace disables it, +trace_start/+trace_end limit the dumped window, +trace_depth the hierarchy
+    const bool trace_on = !Verilated::commandArgsPlusMatch("notrace")[0];
+    const long trace_start = plusarg_int("trace_start", 0);
+    const long trace_end = plusarg_int("trace_end", -1); // -1: until the end
+    TraceFile* tfp = nullptr;
 
     SimDriver* driver = new SimDriver(top);
-    top->trace(tfp, 99);
-    tfp->open("wave.vcd"); 
+    if (trace_on) {
+        Verilated::traceEverOn(true);
+        tfp = new TraceFile;
+        top->trace(tfp, static_cast<int>(plusarg_int("trace_depth", 99)));
+        tfp->open(WAVE_FILE);
+    }
 
     int main_time = 0;
     while (main_time < 70) { // 稍微跑长一点
@@ -26,14 +73,19 @@ int main(int argc, char** argv) {
         }
 
         top->eval();
-        tfp->dump(main_time); // 将当前时刻的数据存入波形
+        if (tfp && main_time >= trace_start && (trace_end < 0 || main_time <= trace_end)) {
+            tfp->dump(main_time); // 将当前时刻的数据存入波形
+        }
         if(top->trigger) {
             printf("Time: %d | Triggered!\n", main_time);
         }
      
         main_time++;
     }
-    tfp->close();
+    if (tfp) {
+        tfp->close();
+        delete tfp;
+    }
 
     delete driver;
     delete top;
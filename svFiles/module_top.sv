@@ -1,9 +1,35 @@
-module module_top (
+module module_top #(
+    parameter int NUM_QUBITS = 3 // set by the Makefile, must match SimDriver (QSIM_NUM_QUBITS)
+) (
     input  logic        clk,
     input  logic        rst_n,
-    output logic   trigger
+    output logic   trigger,
+    output logic   seq_done
 );
+    // gate opcodes, keep in sync with cppFiles/head/GateStream.hpp
+    localparam int OP_H    = 2;
+    localparam int OP_CNOT = 3;
+    localparam int OP_SWAP = 4;
+    localparam int OP_RZ   = 7;
+
+    // gates issued in the same cycle are applied by the simulator as one batch
+    import "DPI-C" function void qsim_issue_gate(input int opcode, input int q0, input int q1, input real param);
+    import "DPI-C" function void qsim_barrier();
+
+    // quantum observables, re-read only when the simulator reports a new state version
+    import "DPI-C" function int  qsim_obs_version();
+    import "DPI-C" function real qsim_trace();
+    import "DPI-C" function real qsim_population(input int q);
+
     logic [7:0] counter;
+    logic [1:0] pc;
+    logic       running;
+    int         obs_version;
+    // only consumed by the waveform
+    // verilator lint_off UNUSED
+    real        q_trace;
+    real        q_pop [NUM_QUBITS]; // P(|1>) per qubit
+    // verilator lint_on UNUSED
 
     always_ff @(posedge clk or negedge rst_n) begin
        counter <= rst_n ? counter + 1 : 8'd0;
@@ -13,4 +39,46 @@ module module_top (
           trigger <= 1'b0;
        end
     end
+
+    // gate program started by trigger, seq_done pulses after the last gate
+    always_ff @(posedge clk or negedge rst_n) begin
+       if (!rst_n) begin
+          pc       <= 2'd0;
+          running  <= 1'b0;
+          seq_done <= 1'b0;
+       end else begin
+          seq_done <= 1'b0;
+          if (trigger && !running) begin
+             running <= 1'b1;
+             pc      <= 2'd0;
+          end else if (running) begin
+             case (pc)
+                2'd0: begin
+                   qsim_issue_gate(OP_H, 0, 0, 0.0);
+                   qsim_issue_gate(OP_RZ, 1, 0, 0.7853981633974483);
+                end
+                2'd1: qsim_issue_gate(OP_CNOT, 0, 1, 0.0);
+                2'd2: begin
+                   qsim_issue_gate(OP_SWAP, 0, 1, 0.0);
+                   qsim_barrier();
+                   running  <= 1'b0;
+                   seq_done <= 1'b1;
+                end
+                default: running <= 1'b0;
+             endcase
+             pc <= pc + 2'd1;
+          end
+       end
+    end
+
+    // real-valued signals in the waveform, they only toggle when the quantum state changed
+    always_ff @(posedge clk) begin
+       if (qsim_obs_version() != obs_version) begin
+          obs_version <= qsim_obs_version();
+          q_trace     <= qsim_trace();
+          for (int q = 0; q < NUM_QUBITS; q++) begin
+             q_pop[q] <= qsim_population(q);
+          end
+       end
+    end
 endmodule